@@ -0,0 +1,99 @@
+#include "IntGridLoader.h"
+
+namespace IntGridLoader
+{
+   bool setIntGridFromCsv(ldtkimport::Level &level, ldtkimport::dimensions_t width, ldtkimport::dimensions_t height, const char *csv, size_t length)
+   {
+      constexpr uint64_t maxValue = static_cast<uint64_t>(std::numeric_limits<ldtkimport::intgridvalue_t>::max());
+
+      values_t values;
+      values.reserve(static_cast<size_t>(width) * static_cast<size_t>(height));
+
+      uint64_t value = 0;
+      bool hasDigits = false;
+      bool valueEnded = false;
+
+      for (size_t i = 0; i < length; ++i)
+      {
+         const char c = csv[i];
+
+         if (c >= '0' && c <= '9')
+         {
+            if (valueEnded)
+            {
+               std::cerr << "IntGrid CSV is missing a comma at character " << i << std::endl;
+               return false;
+            }
+            value = (value * 10) + static_cast<uint64_t>(c - '0');
+            if (value > maxValue)
+            {
+               std::cerr << "IntGrid CSV value at character " << i << " is bigger than " << maxValue << std::endl;
+               return false;
+            }
+            hasDigits = true;
+         }
+         else if (c == ',')
+         {
+            if (!hasDigits)
+            {
+               std::cerr << "IntGrid CSV has an empty value at character " << i << std::endl;
+               return false;
+            }
+            values.push_back(static_cast<ldtkimport::intgridvalue_t>(value));
+            value = 0;
+            hasDigits = false;
+            valueEnded = false;
+         }
+         else if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+         {
+            valueEnded = hasDigits;
+         }
+         else
+         {
+            std::cerr << "IntGrid CSV has unexpected character '" << c << "' at character " << i << std::endl;
+            return false;
+         }
+      }
+
+      // last value doesn't need a trailing comma
+      if (hasDigits)
+      {
+         values.push_back(static_cast<ldtkimport::intgridvalue_t>(value));
+      }
+
+      // values were range-checked while parsing
+      if (!checkCount(width, height, values.size()))
+      {
+         return false;
+      }
+
+      return copyToLevel(level, width, height, values.data());
+   }
+
+   bool loadCsvFile(ldtkimport::Level &level, ldtkimport::dimensions_t width, ldtkimport::dimensions_t height, const std::string &filename)
+   {
+      std::ifstream file(filename, std::ios::binary | std::ios::ate);
+      if (!file)
+      {
+         std::cerr << "Could not load: " << filename << std::endl;
+         return false;
+      }
+
+      const std::streamoff fileSize = file.tellg();
+      if (fileSize < 0)
+      {
+         std::cerr << "Failed to read: " << filename << std::endl;
+         return false;
+      }
+
+      std::string csv(static_cast<size_t>(fileSize), '\0');
+      file.seekg(0);
+      if (!file.read(&csv[0], fileSize))
+      {
+         std::cerr << "Failed to read: " << filename << std::endl;
+         return false;
+      }
+
+      return setIntGridFromCsv(level, width, height, csv.data(), csv.size());
+   }
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "ldtkimport/Level.h"
+
+/// Ways to fill a Level's IntGrid from data that didn't come from an initializer list:
+/// raw buffers of any integer type, LDtk CSV text, and raw binary files.
+///
+/// Every function validates that the number of values matches width * height
+/// and that every value fits in ldtkimport::intgridvalue_t (negative values are rejected).
+/// On failure, an error is printed to std::cerr and false is returned.
+///
+/// Level has no API to take a buffer or to expose its IntGrid storage, so values are always
+/// copied into it cell by cell (see copyToLevel). This is meant for IntGrids made at runtime,
+/// like the ones RuleEngineVerifier generates. IntGrids known at compile time are faster
+/// to give to Level::setIntGrid directly as an initializer list, like main.cpp does.
+namespace IntGridLoader
+{
+   using values_t = std::vector<ldtkimport::intgridvalue_t>;
+
+   inline bool checkCount(ldtkimport::dimensions_t width, ldtkimport::dimensions_t height, size_t count)
+   {
+      const size_t expectedCount = static_cast<size_t>(width) * static_cast<size_t>(height);
+      if (count != expectedCount)
+      {
+         std::cerr << "IntGrid of " << width << "x" << height << " needs " << expectedCount << " values, but got " << count << std::endl;
+         return false;
+      }
+      return true;
+   }
+
+   /// Checks that all values can be stored as an intgridvalue_t.
+   /// The min/max reduction is kept branch-free so the compiler can vectorize it.
+   template<typename T>
+   bool checkRange(const T *values, size_t count)
+   {
+      static_assert(std::is_integral<T>::value, "IntGrid values need to be of an integer type");
+
+      if (count == 0)
+      {
+         return true;
+      }
+
+      T minValue = values[0];
+      T maxValue = values[0];
+      for (size_t i = 1; i < count; ++i)
+      {
+         minValue = values[i] < minValue ? values[i] : minValue;
+         maxValue = values[i] > maxValue ? values[i] : maxValue;
+      }
+
+      // both are compared as unsigned only after ruling out negative values
+      constexpr uintmax_t limit = static_cast<uintmax_t>(std::numeric_limits<ldtkimport::intgridvalue_t>::max());
+      if ((std::is_signed<T>::value && minValue < static_cast<T>(0)) || static_cast<uintmax_t>(maxValue) > limit)
+      {
+         std::cerr << "IntGrid values need to be within 0 and " << limit << ", but got values from " << +minValue << " to " << +maxValue << std::endl;
+         return false;
+      }
+
+      return true;
+   }
+
+   /// The one place values get written into a Level.
+   /// Level only takes a whole IntGrid through setIntGrid's initializer list,
+   /// which can't be built at runtime, so the IntGrid is sized with an empty list
+   /// and each cell is then written through getIntGrid().
+   /// Values need to be checked with checkCount and checkRange beforehand.
+   template<typename T>
+   bool copyToLevel(ldtkimport::Level &level, ldtkimport::dimensions_t width, ldtkimport::dimensions_t height, const T *values)
+   {
+      level.setIntGrid(width, height, {});
+
+      auto &intGrid = level.getIntGrid();
+      if (intGrid.getWidth() != width || intGrid.getHeight() != height)
+      {
+         // don't write past what the IntGrid actually has
+         std::cerr << "IntGrid was sized to " << intGrid.getWidth() << "x" << intGrid.getHeight() << " instead of " << width << "x" << height << std::endl;
+         return false;
+      }
+
+      size_t idx = 0;
+      for (int cellY = 0; cellY < height; ++cellY)
+      {
+         for (int cellX = 0; cellX < width; ++cellX, ++idx)
+         {
+            intGrid(cellX, cellY) = static_cast<ldtkimport::intgridvalue_t>(values[idx]);
+         }
+      }
+
+      return true;
+   }
+
+   /// Copies values from a buffer of any integer type, converting each to intgridvalue_t.
+   template<typename T>
+   bool setIntGrid(ldtkimport::Level &level, ldtkimport::dimensions_t width, ldtkimport::dimensions_t height, const T *values, size_t count)
+   {
+      if (!checkCount(width, height, count) || !checkRange(values, count))
+      {
+         return false;
+      }
+
+      return copyToLevel(level, width, height, values);
+   }
+
+   template<typename T>
+   bool setIntGrid(ldtkimport::Level &level, ldtkimport::dimensions_t width, ldtkimport::dimensions_t height, const std::vector<T> &values)
+   {
+      return setIntGrid(level, width, height, values.data(), values.size());
+   }
+
+   /// Parses an IntGrid in the CSV format LDtk uses (in "intGridCsv" and in its
+   /// simplified export): unsigned integers separated by commas, with any amount
+   /// of whitespace or newlines, and an optional trailing comma.
+   bool setIntGridFromCsv(ldtkimport::Level &level, ldtkimport::dimensions_t width, ldtkimport::dimensions_t height, const char *csv, size_t length);
+
+   /// Loads an LDtk CSV file (see setIntGridFromCsv).
+   bool loadCsvFile(ldtkimport::Level &level, ldtkimport::dimensions_t width, ldtkimport::dimensions_t height, const std::string &filename);
+
+   /// Loads a raw binary file holding exactly width * height values of type T, in native byte order.
+   /// The file is read into a temporary buffer first, since there's no Level storage to read it into directly.
+   template<typename T>
+   bool loadRawFile(ldtkimport::Level &level, ldtkimport::dimensions_t width, ldtkimport::dimensions_t height, const std::string &filename)
+   {
+      std::ifstream file(filename, std::ios::binary | std::ios::ate);
+      if (!file)
+      {
+         std::cerr << "Could not load: " << filename << std::endl;
+         return false;
+      }
+
+      const std::streamoff fileSize = file.tellg();
+      if (fileSize < 0)
+      {
+         std::cerr << "Failed to read: " << filename << std::endl;
+         return false;
+      }
+
+      if (static_cast<uintmax_t>(fileSize) % sizeof(T) != 0)
+      {
+         std::cerr << filename << " has a size of " << fileSize << " bytes, which is not a multiple of " << sizeof(T) << std::endl;
+         return false;
+      }
+
+      const size_t count = static_cast<size_t>(fileSize) / sizeof(T);
+      if (!checkCount(width, height, count))
+      {
+         return false;
+      }
+
+      std::vector<T> values(count);
+      file.seekg(0);
+      if (!file.read(reinterpret_cast<char*>(values.data()), fileSize))
+      {
+         std::cerr << "Failed to read: " << filename << std::endl;
+         return false;
+      }
+
+      return setIntGrid(level, width, height, values.data(), values.size());
+   }
+}
@@ -0,0 +1,123 @@
+#include <iostream>
+
+#include <yyjson.h>
+
+#include "LdtkFileInfo.h"
+
+namespace LdtkFileInfo
+{
+   namespace
+   {
+      /// Gets the "defs" object of an .ldtk file. Returns nullptr (and prints why) if there's none.
+      yyjson_val *getDefs(yyjson_doc *doc, const std::string &filename)
+      {
+         yyjson_val *defs = yyjson_obj_get(yyjson_doc_get_root(doc), "defs");
+         if (!yyjson_is_obj(defs))
+         {
+            std::cerr << "No defs found in: " << filename << std::endl;
+            return nullptr;
+         }
+         return defs;
+      }
+
+      yyjson_doc *readDoc(const std::string &filename)
+      {
+         yyjson_read_err err;
+         yyjson_doc *doc = yyjson_read_file(filename.c_str(), YYJSON_READ_NOFLAG, nullptr, &err);
+         if (doc == nullptr)
+         {
+            std::cerr << "Could not load: " << filename << " (" << err.msg << " at byte " << err.pos << ")" << std::endl;
+         }
+         return doc;
+      }
+   }
+
+   bool readTileSetTileCounts(const std::string &filename, std::unordered_map<ldtkimport::uid_t, size_t> &outTileCounts)
+   {
+      yyjson_doc *doc = readDoc(filename);
+      if (doc == nullptr)
+      {
+         return false;
+      }
+
+      yyjson_val *defs = getDefs(doc, filename);
+      if (defs == nullptr)
+      {
+         yyjson_doc_free(doc);
+         return false;
+      }
+
+      size_t idx, max;
+      yyjson_val *tileset;
+      yyjson_arr_foreach(yyjson_obj_get(defs, "tilesets"), idx, max, tileset)
+      {
+         yyjson_val *uid = yyjson_obj_get(tileset, "uid");
+         yyjson_val *columns = yyjson_obj_get(tileset, "__cWid");
+         yyjson_val *rows = yyjson_obj_get(tileset, "__cHei");
+         if (!yyjson_is_int(uid) || !yyjson_is_int(columns) || !yyjson_is_int(rows))
+         {
+            continue;
+         }
+
+         const int columnCount = yyjson_get_int(columns);
+         const int rowCount = yyjson_get_int(rows);
+         const size_t tileCount = (columnCount > 0 && rowCount > 0) ? static_cast<size_t>(columnCount) * static_cast<size_t>(rowCount) : 0;
+
+         outTileCounts[static_cast<ldtkimport::uid_t>(yyjson_get_int(uid))] = tileCount;
+      }
+
+      yyjson_doc_free(doc);
+      return true;
+   }
+
+   bool readIntGridValues(const std::string &filename, const std::string &layerName, std::vector<ldtkimport::intgridvalue_t> &outValues)
+   {
+      yyjson_doc *doc = readDoc(filename);
+      if (doc == nullptr)
+      {
+         return false;
+      }
+
+      yyjson_val *defs = getDefs(doc, filename);
+      if (defs == nullptr)
+      {
+         yyjson_doc_free(doc);
+         return false;
+      }
+
+      bool foundLayer = false;
+
+      size_t layerIdx, layerMax;
+      yyjson_val *layer;
+      yyjson_arr_foreach(yyjson_obj_get(defs, "layers"), layerIdx, layerMax, layer)
+      {
+         const char *identifier = yyjson_get_str(yyjson_obj_get(layer, "identifier"));
+         if (identifier == nullptr || layerName != identifier)
+         {
+            continue;
+         }
+
+         foundLayer = true;
+
+         size_t valueIdx, valueMax;
+         yyjson_val *intGridValue;
+         yyjson_arr_foreach(yyjson_obj_get(layer, "intGridValues"), valueIdx, valueMax, intGridValue)
+         {
+            yyjson_val *value = yyjson_obj_get(intGridValue, "value");
+            if (yyjson_is_int(value))
+            {
+               outValues.push_back(static_cast<ldtkimport::intgridvalue_t>(yyjson_get_int(value)));
+            }
+         }
+         break;
+      }
+
+      yyjson_doc_free(doc);
+
+      if (!foundLayer)
+      {
+         std::cerr << "Layer " << layerName << " was not found in: " << filename << std::endl;
+      }
+      return foundLayer;
+   }
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ldtkimport/LdtkDefFile.h"
+
+/// Reads definitions from an .ldtk file that LdtkDefFile doesn't expose.
+/// These are read straight from the file's JSON with yyjson (already a dependency in vcpkg.json).
+namespace LdtkFileInfo
+{
+   /// Gets how many tiles each tileset has, keyed by tileset uid.
+   /// This is the tileset's own tile grid ("__cWid" x "__cHei"), which already accounts for
+   /// the tileset's tile size, spacing, and padding, and which tileIds index into.
+   bool readTileSetTileCounts(const std::string &filename, std::unordered_map<ldtkimport::uid_t, size_t> &outTileCounts);
+
+   /// Gets the values defined in an IntGrid layer (its "intGridValues"), found by layer name.
+   /// These don't have to be contiguous. Returns false if there's no layer with that name.
+   bool readIntGridValues(const std::string &filename, const std::string &layerName, std::vector<ldtkimport::intgridvalue_t> &outValues);
+}
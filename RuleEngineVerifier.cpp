@@ -0,0 +1,346 @@
+#include <random>
+#include <utility>
+
+#include "RuleEngineVerifier.h"
+#include "IntGridLoader.h"
+
+namespace RuleEngineVerifier
+{
+   namespace
+   {
+      /// All engines that --verify can pick by name. Add new engines here.
+      const std::vector<std::pair<std::string, RuleEngine>> &getEngines()
+      {
+         static const std::vector<std::pair<std::string, RuleEngine>> engines =
+         {
+            { "reference", runReference },
+         };
+         return engines;
+      }
+
+#if !defined(NDEBUG) && LDTK_IMPORT_DEBUG_RULE > 0
+      /// An engine might not fill its RulesLog, or fill it differently, so check before reading it.
+      void writeRuleUid(const ldtkimport::RulesLog &rulesLog, size_t tileGridIdx, size_t cellIdx, size_t tileIdx, std::ostream &report)
+      {
+         if (tileGridIdx < rulesLog.tileGrid.size() &&
+            cellIdx < rulesLog.tileGrid[tileGridIdx].size() &&
+            tileIdx < rulesLog.tileGrid[tileGridIdx][cellIdx].size())
+         {
+            report << ", Rule Uid " << rulesLog.tileGrid[tileGridIdx][cellIdx][tileIdx];
+         }
+         else
+         {
+            report << ", unknown rule";
+         }
+      }
+#endif
+
+      bool isSameTile(const ldtkimport::TileInCell &a, const ldtkimport::TileInCell &b)
+      {
+         return a.tileId == b.tileId &&
+            a.priority == b.priority &&
+            a.opacity == b.opacity &&
+            a.posXOffset == b.posXOffset &&
+            a.posYOffset == b.posYOffset &&
+            a.isFlippedX() == b.isFlippedX() &&
+            a.isFlippedY() == b.isFlippedY() &&
+            a.hasOffsetUp() == b.hasOffsetUp() &&
+            a.hasOffsetDown() == b.hasOffsetDown() &&
+            a.hasOffsetLeft() == b.hasOffsetLeft() &&
+            a.hasOffsetRight() == b.hasOffsetRight() &&
+            a.isFinal() == b.isFinal();
+      }
+
+      void writeTile(const ldtkimport::TileInCell &tile, std::ostream &report)
+      {
+         report << "Tile Id " << tile.tileId <<
+            ", Priority " << +(tile.priority) <<
+            ", Opacity " << +(tile.opacity) << "%" <<
+            ", Pixel Offset (" << +(tile.posXOffset) << ", " << +(tile.posYOffset) << ")";
+
+         report << ", Half-cell Offsets:";
+         if (tile.hasOffsetUp())
+         {
+            report << " up";
+         }
+         if (tile.hasOffsetDown())
+         {
+            report << " down";
+         }
+         if (tile.hasOffsetLeft())
+         {
+            report << " left";
+         }
+         if (tile.hasOffsetRight())
+         {
+            report << " right";
+         }
+
+         report << ", Flipped:";
+         if (tile.isFlippedX())
+         {
+            report << " X";
+         }
+         if (tile.isFlippedY())
+         {
+            report << " Y";
+         }
+
+         if (tile.isFinal())
+         {
+            report << ", Final";
+         }
+      }
+   }
+
+   void runReference(
+      ldtkimport::LdtkDefFile &ldtk,
+#if !defined(NDEBUG) && LDTK_IMPORT_DEBUG_RULE > 0
+      ldtkimport::RulesLog &rulesLog,
+#endif
+      ldtkimport::Level &level,
+      uint8_t runSettings)
+   {
+      ldtk.runRules(
+#if !defined(NDEBUG) && LDTK_IMPORT_DEBUG_RULE > 0
+         rulesLog,
+#endif
+         level, runSettings);
+   }
+
+   const RuleEngine *findEngine(const std::string &name)
+   {
+      for (const auto &engine : getEngines())
+      {
+         if (engine.first == name)
+         {
+            return &engine.second;
+         }
+      }
+      return nullptr;
+   }
+
+   void writeEngineNames(std::ostream &out)
+   {
+      const auto &engines = getEngines();
+      for (size_t idx = 0; idx < engines.size(); ++idx)
+      {
+         out << (idx > 0 ? " " : "") << engines[idx].first;
+      }
+   }
+
+   bool compare(
+#if !defined(NDEBUG) && LDTK_IMPORT_DEBUG_RULE > 0
+      const ldtkimport::RulesLog &expectedRulesLog,
+      const ldtkimport::RulesLog &actualRulesLog,
+#endif
+      ldtkimport::LdtkDefFile &ldtk,
+      const ldtkimport::Level &expected,
+      const ldtkimport::Level &actual,
+      std::ostream &report)
+   {
+      if (expected.getWidth() != actual.getWidth() || expected.getHeight() != actual.getHeight())
+      {
+         report << "Level size differs. Expected: " << expected.getWidth() << "x" << expected.getHeight() <<
+            " Actual: " << actual.getWidth() << "x" << actual.getHeight() << std::endl;
+         return false;
+      }
+
+      if (expected.getTileGridCount() != actual.getTileGridCount())
+      {
+         report << "TileGrid count differs. Expected: " << expected.getTileGridCount() <<
+            " Actual: " << actual.getTileGridCount() << std::endl;
+         return false;
+      }
+
+      const int cellCountX = expected.getWidth();
+      const int cellCountY = expected.getHeight();
+
+      for (int tileGridIdx = 0, tileGridEnd = expected.getTileGridCount(); tileGridIdx < tileGridEnd; ++tileGridIdx)
+      {
+         const auto &expectedTileGrid = expected.getTileGridByIdx(tileGridIdx);
+         const auto &actualTileGrid = actual.getTileGridByIdx(tileGridIdx);
+
+         if (expectedTileGrid.getLayerUid() != actualTileGrid.getLayerUid())
+         {
+            // Comparing tiles would mean comparing different layers.
+            report << "TileGrid " << tileGridIdx << " is for a different layer. Expected Layer Uid: " << expectedTileGrid.getLayerUid() <<
+               " Actual Layer Uid: " << actualTileGrid.getLayerUid() << std::endl;
+            return false;
+         }
+
+         for (int cellY = 0; cellY < cellCountY; ++cellY)
+         {
+            for (int cellX = 0; cellX < cellCountX; ++cellX)
+            {
+               const auto &expectedTiles = expectedTileGrid(cellX, cellY);
+               const auto &actualTiles = actualTileGrid(cellX, cellY);
+
+               // Go up to the longer of the two, so a missing or extra tile is reported at the index it appears.
+               const size_t tileCount = expectedTiles.size() > actualTiles.size() ? expectedTiles.size() : actualTiles.size();
+
+               for (size_t tileIdx = 0; tileIdx < tileCount; ++tileIdx)
+               {
+                  const bool hasExpected = tileIdx < expectedTiles.size();
+                  const bool hasActual = tileIdx < actualTiles.size();
+
+                  if (hasExpected && hasActual && isSameTile(expectedTiles[tileIdx], actualTiles[tileIdx]))
+                  {
+                     continue;
+                  }
+
+                  // Found the first divergence.
+
+                  const ldtkimport::Layer *layer = ldtk.getLayerByUid(expectedTileGrid.getLayerUid());
+                  if (layer != nullptr)
+                  {
+                     report << "Layer " << layer->name;
+                  }
+                  else
+                  {
+                     report << "TileGrid " << tileGridIdx;
+                  }
+                  report << " differs at cell (" << cellX << ", " << cellY << "), tile " << (tileIdx + 1) <<
+                     " (expected " << expectedTiles.size() << " tiles, got " << actualTiles.size() << ")" << std::endl;
+
+#if !defined(NDEBUG) && LDTK_IMPORT_DEBUG_RULE > 0
+                  const size_t cellIdx = ldtkimport::GridUtility::getIndex(cellX, cellY, expectedTileGrid.getWidth());
+#endif
+
+                  report << "   Expected: ";
+                  if (hasExpected)
+                  {
+                     writeTile(expectedTiles[tileIdx], report);
+#if !defined(NDEBUG) && LDTK_IMPORT_DEBUG_RULE > 0
+                     writeRuleUid(expectedRulesLog, tileGridIdx, cellIdx, tileIdx, report);
+#endif
+                  }
+                  else
+                  {
+                     report << "no tile";
+                  }
+                  report << std::endl;
+
+                  report << "   Actual: ";
+                  if (hasActual)
+                  {
+                     writeTile(actualTiles[tileIdx], report);
+#if !defined(NDEBUG) && LDTK_IMPORT_DEBUG_RULE > 0
+                     writeRuleUid(actualRulesLog, tileGridIdx, cellIdx, tileIdx, report);
+#endif
+                  }
+                  else
+                  {
+                     report << "no tile";
+                  }
+                  report << std::endl;
+
+#if defined(NDEBUG) || !(LDTK_IMPORT_DEBUG_RULE > 0)
+                  report << "   (use a debug build with LDTK_IMPORT_DEBUG_RULE to see which rule placed each tile)" << std::endl;
+#endif
+                  return false;
+               } // for tiles
+            } // for cellX
+         } // for cellY
+      } // for TileGrid
+
+      return true;
+   }
+
+   bool verify(
+      ldtkimport::LdtkDefFile &ldtk,
+      const RuleEngine &alternative,
+      uint8_t runSettings,
+      ldtkimport::dimensions_t width,
+      ldtkimport::dimensions_t height,
+      const std::vector<ldtkimport::intgridvalue_t> &values,
+      std::ostream &report)
+   {
+      if ((runSettings & ldtkimport::RunSettings::RandomizeSeeds) != 0)
+      {
+         report << "RandomizeSeeds can't be verified, each run would randomize to different seeds" << std::endl;
+         return false;
+      }
+
+      // Both Levels get their own copy of the same IntGrid,
+      // so nothing one engine does can leak into the other's input.
+      ldtkimport::Level expected;
+      ldtkimport::Level actual;
+      if (!IntGridLoader::setIntGrid(expected, width, height, values.data(), values.size()) ||
+         !IntGridLoader::setIntGrid(actual, width, height, values.data(), values.size()))
+      {
+         return false;
+      }
+
+#if !defined(NDEBUG) && LDTK_IMPORT_DEBUG_RULE > 0
+      ldtkimport::RulesLog expectedRulesLog;
+      ldtkimport::RulesLog actualRulesLog;
+#endif
+
+      runReference(
+         ldtk,
+#if !defined(NDEBUG) && LDTK_IMPORT_DEBUG_RULE > 0
+         expectedRulesLog,
+#endif
+         expected, runSettings);
+
+      alternative(
+         ldtk,
+#if !defined(NDEBUG) && LDTK_IMPORT_DEBUG_RULE > 0
+         actualRulesLog,
+#endif
+         actual, runSettings);
+
+      return compare(
+#if !defined(NDEBUG) && LDTK_IMPORT_DEBUG_RULE > 0
+         expectedRulesLog,
+         actualRulesLog,
+#endif
+         ldtk, expected, actual, report);
+   }
+
+   bool fuzz(
+      ldtkimport::LdtkDefFile &ldtk,
+      const RuleEngine &alternative,
+      uint8_t runSettings,
+      uint32_t seed,
+      size_t iterations,
+      const std::vector<ldtkimport::intgridvalue_t> &valueSet,
+      ldtkimport::dimensions_t maxSize,
+      std::ostream &report)
+   {
+      if (valueSet.empty() || maxSize == 0)
+      {
+         report << "Need at least one IntGrid value and a size bigger than 0 to fuzz" << std::endl;
+         return false;
+      }
+
+      std::vector<ldtkimport::intgridvalue_t> values;
+
+      for (size_t iteration = 0; iteration < iterations; ++iteration)
+      {
+         // Values come straight from the std::mt19937 output instead of std::uniform_int_distribution,
+         // whose algorithm differs between standard libraries, so a seed replays the same IntGrid on any platform.
+         const uint32_t iterationSeed = seed + static_cast<uint32_t>(iteration);
+         std::mt19937 random(iterationSeed);
+
+         const auto width = static_cast<ldtkimport::dimensions_t>(1 + (random() % maxSize));
+         const auto height = static_cast<ldtkimport::dimensions_t>(1 + (random() % maxSize));
+
+         values.resize(static_cast<size_t>(width) * static_cast<size_t>(height));
+         for (auto &value : values)
+         {
+            value = valueSet[random() % valueSet.size()];
+         }
+
+         if (!verify(ldtk, alternative, runSettings, width, height, values, report))
+         {
+            report << "Failed on iteration " << iteration << " with seed " << iterationSeed <<
+               " (" << width << "x" << height << " IntGrid, run settings " << +runSettings << ")" << std::endl;
+            return false;
+         }
+      }
+
+      return true;
+   }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "ldtkimport/LdtkDefFile.h"
+#include "ldtkimport/Level.h"
+
+/// Differential testing of rule engines: runs the reference engine (LdtkDefFile::runRules)
+/// and an alternative engine on the same IntGrid, then compares every TileGrid cell tile by tile.
+///
+/// Both engines get the same RunSettings flags (see ldtkimport::RunSettings), and both use the rule seeds
+/// saved in the ldtk file. RandomizeSeeds is rejected, since there's no way from here to make two runs
+/// randomize to the same seeds, and different seeds would show up as divergences.
+namespace RuleEngineVerifier
+{
+   /// Any function that fills the TileGrids of a Level from its IntGrid, like LdtkDefFile::runRules does.
+   using RuleEngine = std::function<void(
+      ldtkimport::LdtkDefFile &ldtk,
+#if !defined(NDEBUG) && LDTK_IMPORT_DEBUG_RULE > 0
+      ldtkimport::RulesLog &rulesLog,
+#endif
+      ldtkimport::Level &level,
+      uint8_t runSettings)>;
+
+   /// The reference engine, what all other engines are checked against. Named "reference" in the engine table.
+   void runReference(
+      ldtkimport::LdtkDefFile &ldtk,
+#if !defined(NDEBUG) && LDTK_IMPORT_DEBUG_RULE > 0
+      ldtkimport::RulesLog &rulesLog,
+#endif
+      ldtkimport::Level &level,
+      uint8_t runSettings);
+
+   /// Gets an engine from the table of known engines by name (see RuleEngineVerifier.cpp to add one).
+   /// Returns nullptr if there's no engine with that name.
+   const RuleEngine *findEngine(const std::string &name);
+
+   /// Writes the names of all known engines, separated by spaces.
+   void writeEngineNames(std::ostream &out);
+
+   /// Compares the TileGrids of two Levels that had rules run on them.
+   /// Returns true if they're identical, otherwise writes the first divergence found to report.
+   bool compare(
+#if !defined(NDEBUG) && LDTK_IMPORT_DEBUG_RULE > 0
+      const ldtkimport::RulesLog &expectedRulesLog,
+      const ldtkimport::RulesLog &actualRulesLog,
+#endif
+      ldtkimport::LdtkDefFile &ldtk,
+      const ldtkimport::Level &expected,
+      const ldtkimport::Level &actual,
+      std::ostream &report);
+
+   /// Runs both the reference and the alternative engine on an IntGrid made from values,
+   /// with the same runSettings, then compares their output (see compare).
+   /// Returns false without running anything if runSettings has RandomizeSeeds.
+   bool verify(
+      ldtkimport::LdtkDefFile &ldtk,
+      const RuleEngine &alternative,
+      uint8_t runSettings,
+      ldtkimport::dimensions_t width,
+      ldtkimport::dimensions_t height,
+      const std::vector<ldtkimport::intgridvalue_t> &values,
+      std::ostream &report);
+
+   /// Verifies the alternative engine against the reference on randomly generated IntGrids,
+   /// with each cell picked from valueSet and sizes from 1x1 to maxSize x maxSize.
+   ///
+   /// Iteration i generates its IntGrid from seed + i, which gets reported on failure.
+   /// Calling fuzz again with that reported seed and 1 iteration replays the exact same IntGrid.
+   ///
+   /// Stops at the first divergence and returns false, or returns true if all iterations matched.
+   bool fuzz(
+      ldtkimport::LdtkDefFile &ldtk,
+      const RuleEngine &alternative,
+      uint8_t runSettings,
+      uint32_t seed,
+      size_t iterations,
+      const std::vector<ldtkimport::intgridvalue_t> &valueSet,
+      ldtkimport::dimensions_t maxSize,
+      std::ostream &report);
+}
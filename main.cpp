@@ -1,5 +1,16 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
 #include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <random>
 #include <string>
+#include <thread>
+#include <vector>
 #include <unordered_map>
 #include <iostream>
 #include <sstream>
@@ -10,6 +21,9 @@
 #include "ldtkimport/LdtkDefFile.h"
 #include "ldtkimport/Level.h"
 
+#include "LdtkFileInfo.h"
+#include "RuleEngineVerifier.h"
+
 using namespace ldtkimport::RunSettings;
 
 struct TileSetImage
@@ -48,6 +62,17 @@ struct LdtkAssets
 
       size_t lastSlashIdx = filename.find_last_of("\\/");
 
+      struct DecodedImage
+      {
+         ldtkimport::uid_t tilesetUid;
+         std::string imagePath;
+         sf::Image image;
+         bool done;
+         bool success;
+      };
+
+      std::vector<DecodedImage> decodedImages;
+
       // Loop through all tilesets and get the filename
       for (auto tileset = ldtk.tilesetCBegin(), end = ldtk.tilesetCEnd(); tileset != end; ++tileset)
       {
@@ -68,19 +93,109 @@ struct LdtkAssets
 
          std::cout << "Loading: " << imagePath << std::endl;
 
-         TileSetImage tileSetImage;
-         if (!tileSetImage.image.loadFromFile(imagePath))
+         decodedImages.push_back(DecodedImage{tileset->uid, imagePath, sf::Image(), false, false});
+      }
+
+      // Decoding the image files doesn't need the OpenGL context,
+      // so that's done by a fixed number of worker threads, each taking the next tileset not yet taken.
+      // Meanwhile, this thread uploads each image in order as soon as it's decoded, then frees it,
+      // since uploading to textures has to happen where the OpenGL context is.
+      //
+      // Workers only report success or failure through decodedImages, and read the files themselves instead of
+      // using sf::Image::loadFromFile, so a missing file doesn't end up in SFML's error stream from several threads at once.
+      std::atomic<size_t> nextImageIdx(0);
+      std::mutex decodedMutex;
+      std::condition_variable decodedCondition;
+
+      auto decodeImages = [&]()
+      {
+         for (size_t idx = nextImageIdx++; idx < decodedImages.size(); idx = nextImageIdx++)
+         {
+            DecodedImage &decodedImage = decodedImages[idx];
+
+            bool success = false;
+            std::ifstream file(decodedImage.imagePath, std::ios::binary);
+            if (file)
+            {
+               std::vector<char> fileData((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+               success = !fileData.empty() && decodedImage.image.loadFromMemory(fileData.data(), fileData.size());
+            }
+
+            {
+               std::lock_guard<std::mutex> lock(decodedMutex);
+               decodedImage.success = success;
+               decodedImage.done = true;
+            }
+            decodedCondition.notify_one();
+         }
+      };
+
+      const size_t workerCount = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), decodedImages.size()));
+      std::vector<std::thread> workers;
+      workers.reserve(workerCount);
+      for (size_t workerIdx = 0; workerIdx < workerCount; ++workerIdx)
+      {
+         workers.emplace_back(decodeImages);
+      }
+
+      // While the workers decode, get how many tiles each tileset has, for sizing the bitsets further down.
+      std::unordered_map<ldtkimport::uid_t, size_t> tileCounts;
+      bool uploadSuccess = LdtkFileInfo::readTileSetTileCounts(filename, tileCounts);
+
+      for (auto &decodedImage : decodedImages)
+      {
+         if (!uploadSuccess)
+         {
+            break;
+         }
+
+         {
+            std::unique_lock<std::mutex> lock(decodedMutex);
+            decodedCondition.wait(lock, [&decodedImage]() { return decodedImage.done; });
+         }
+
+         if (!decodedImage.success)
+         {
+            std::cerr << "Failed to load: " << decodedImage.imagePath << std::endl;
+            uploadSuccess = false;
+            break;
+         }
+
+         TileSetImage &tileSetImage = tilesetImages[decodedImage.tilesetUid];
+         if (!tileSetImage.image.loadFromImage(decodedImage.image))
          {
-            std::cerr << "Failed to load: " << imagePath << std::endl;
-            return false;
+            std::cerr << "Failed to load: " << decodedImage.imagePath << std::endl;
+            uploadSuccess = false;
+            break;
          }
 
-         tilesetImages.insert(std::make_pair(tileset->uid, tileSetImage));
+         // pixels are in the texture now, no need to keep them around until all uploads are done
+         decodedImage.image = sf::Image();
+      }
+
+      if (!uploadSuccess)
+      {
+         // stop workers from taking more tilesets
+         nextImageIdx = decodedImages.size();
+      }
+
+      for (auto &worker : workers)
+      {
+         worker.join();
+      }
+
+      if (!uploadSuccess)
+      {
+         return false;
       }
 
       // Assign the IntRects
       // To get which IntRects should be used, we'll have to go through all rules of all layers.
       // This allows us to skip creating IntRects for unused tiles.
+      // Tiles already assigned are tracked with one bitset per tileset (indexed by tileId),
+      // so checking a tile doesn't need a hash map lookup.
+      std::unordered_map<ldtkimport::uid_t, std::vector<bool>> assignedTiles;
+
       for (auto layer = ldtk.layerCBegin(), layerEnd = ldtk.layerCEnd(); layer != layerEnd; ++layer)
       {
          const ldtkimport::TileSet *tileset = ldtk.getTileset(layer->tilesetDefUid);
@@ -90,15 +205,29 @@ struct LdtkAssets
             continue;
          }
 
-         if (tilesetImages.count(tileset->uid) == 0)
+         auto tilesetImageIt = tilesetImages.find(tileset->uid);
+         if (tilesetImageIt == tilesetImages.end())
          {
             std::cerr << "TileSet " << tileset->uid << " was not found in tilesetImages" << std::endl;
             continue;
          }
 
-         auto &tilesetImage = tilesetImages[tileset->uid];
+         auto &tilesetImage = tilesetImageIt->second;
          const double cellPixelSize = layer->cellPixelSize;
 
+         auto assignedIt = assignedTiles.find(tileset->uid);
+         if (assignedIt == assignedTiles.end())
+         {
+            auto tileCountIt = tileCounts.find(tileset->uid);
+            if (tileCountIt == tileCounts.end())
+            {
+               std::cerr << "TileSet " << tileset->uid << " has no tile grid size in " << filename << std::endl;
+               continue;
+            }
+            assignedIt = assignedTiles.insert(std::make_pair(tileset->uid, std::vector<bool>(tileCountIt->second, false))).first;
+         }
+         auto &assigned = assignedIt->second;
+
          for (auto ruleGroup = layer->ruleGroups.cbegin(), ruleGroupEnd = layer->ruleGroups.cend(); ruleGroup != ruleGroupEnd; ++ruleGroup)
          {
             for (auto rule = ruleGroup->rules.cbegin(), ruleEnd = ruleGroup->rules.cend(); rule != ruleEnd; ++rule)
@@ -108,12 +237,21 @@ struct LdtkAssets
                {
                   ldtkimport::tileid_t tileId = (*tile);
 
-                  if (tilesetImage.tiles.count(tileId) > 0)
+                  if (tileId < 0 || static_cast<size_t>(tileId) >= assigned.size())
+                  {
+                     std::cerr << "Tile " << tileId << " is outside of TileSet " << tileset->uid << " which has " << assigned.size() << " tiles" << std::endl;
+                     continue;
+                  }
+
+                  const size_t tileIdx = static_cast<size_t>(tileId);
+                  if (assigned[tileIdx])
                   {
                      // this tileId is already assigned, skip it
                      continue;
                   }
 
+                  assigned[tileIdx] = true;
+
                   int16_t tileX, tileY;
                   tileset->getCoordinates(tileId, tileX, tileY);
 
@@ -299,8 +437,137 @@ struct CellInfo
    const ldtkimport::TileInCell &tileInfo;
 };
 
-int main()
+/// Only accepts a whole, non-negative decimal number that fits in an unsigned long.
+bool parseUnsigned(const char *text, unsigned long &outValue)
+{
+   if (text[0] < '0' || text[0] > '9')
+   {
+      // strtoul would otherwise skip whitespace and accept a minus sign
+      return false;
+   }
+
+   char *end = nullptr;
+   errno = 0;
+   const unsigned long value = std::strtoul(text, &end, 10);
+   if (errno == ERANGE || *end != '\0')
+   {
+      return false;
+   }
+
+   outValue = value;
+   return true;
+}
+
+/// Checks a rule engine against the reference LdtkDefFile::runRules on random IntGrids.
+/// Run with: ldtkimport-demo --verify [--engine name] [iterations] [seed] [FasterStampBreakOnMatch]
+int runVerification(const RuleEngineVerifier::RuleEngine &alternative, size_t iterations, uint32_t seed, uint8_t runSettings)
 {
+   ldtkimport::LdtkDefFile ldtk;
+
+#if !defined(NDEBUG) && LDTK_IMPORT_DEBUG_RULE > 0
+   ldtkimport::RulesLog rulesLog;
+#endif
+   bool loadSuccess = ldtk.loadFromFile(
+#if !defined(NDEBUG) && LDTK_IMPORT_DEBUG_RULE > 0
+      rulesLog,
+#endif
+      "assets/Demo.ldtk", false);
+
+   if (!loadSuccess)
+   {
+      std::cerr << "Could not load: assets/Demo.ldtk" << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   // Note: I hardcode to layer index 2 because I know that's where the intgrid is in the ldtk file for this demo.
+   // 0 is an empty cell, the rest are whatever values the layer defines.
+   std::vector<ldtkimport::intgridvalue_t> valueSet{0};
+   if (!LdtkFileInfo::readIntGridValues("assets/Demo.ldtk", ldtk.getLayerByIdx(2).name, valueSet))
+   {
+      return EXIT_FAILURE;
+   }
+
+   std::cout << "Verifying " << iterations << " random IntGrids from seed " << seed << " with run settings " << +runSettings << std::endl;
+
+   if (!RuleEngineVerifier::fuzz(ldtk, alternative, runSettings, seed, iterations, valueSet, 64, std::cout))
+   {
+      return EXIT_FAILURE;
+   }
+
+   std::cout << "All " << iterations << " IntGrids matched" << std::endl;
+   return EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[])
+{
+   if (argc > 1 && std::string(argv[1]) == "--verify")
+   {
+      std::string engineName = "reference";
+      std::vector<const char*> positionalArgs;
+      for (int argIdx = 2; argIdx < argc; ++argIdx)
+      {
+         if (std::string(argv[argIdx]) == "--engine")
+         {
+            if (argIdx + 1 >= argc)
+            {
+               std::cerr << "--engine needs a name" << std::endl;
+               return EXIT_FAILURE;
+            }
+            engineName = argv[++argIdx];
+         }
+         else
+         {
+            positionalArgs.push_back(argv[argIdx]);
+         }
+      }
+
+      // Checking the reference against itself is still useful, it shows runRules is deterministic.
+      const RuleEngineVerifier::RuleEngine *alternative = RuleEngineVerifier::findEngine(engineName);
+      if (alternative == nullptr)
+      {
+         std::cerr << "Unknown engine: " << engineName << ". Known engines: ";
+         RuleEngineVerifier::writeEngineNames(std::cerr);
+         std::cerr << std::endl;
+         return EXIT_FAILURE;
+      }
+
+      unsigned long iterations = 1000;
+      if (positionalArgs.size() > 0 && (!parseUnsigned(positionalArgs[0], iterations) || iterations == 0))
+      {
+         std::cerr << "Iteration count needs to be a number bigger than 0, but got: " << positionalArgs[0] << std::endl;
+         return EXIT_FAILURE;
+      }
+
+      unsigned long seed = std::random_device()();
+      if (positionalArgs.size() > 1 && (!parseUnsigned(positionalArgs[1], seed) || seed > UINT32_MAX))
+      {
+         std::cerr << "Seed needs to be a number from 0 to " << UINT32_MAX << ", but got: " << positionalArgs[1] << std::endl;
+         return EXIT_FAILURE;
+      }
+
+      uint8_t runSettings = 0;
+      for (size_t argIdx = 2; argIdx < positionalArgs.size(); ++argIdx)
+      {
+         const std::string flag(positionalArgs[argIdx]);
+         if (flag == "FasterStampBreakOnMatch")
+         {
+            runSettings |= FasterStampBreakOnMatch;
+         }
+         else if (flag == "RandomizeSeeds")
+         {
+            std::cerr << "RandomizeSeeds can't be verified, each run would randomize to different seeds" << std::endl;
+            return EXIT_FAILURE;
+         }
+         else
+         {
+            std::cerr << "Unknown run setting: " << flag << std::endl;
+            return EXIT_FAILURE;
+         }
+      }
+
+      return runVerification(*alternative, iterations, static_cast<uint32_t>(seed), runSettings);
+   }
+
    // gets rid of annoying "Failed to set DirectInput device axis mode: 1" spam message
    sf::err().rdbuf(nullptr);
 